@@ -0,0 +1,1201 @@
+#include "airlineFlow.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <queue>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+
+namespace {
+
+/*  Workspace memory
+    Every container of the solver allocates through Pooled<T>. While a call
+    runs, new blocks come from the arena of its workspace, and released blocks
+    go back to the free list of their size in the arena that gave them (each
+    block starts with its owner), ready to be handed out again.
+*/
+struct Arena {
+    map<size_t, vector<void*>> free;    // free[units]: released blocks of that size
+
+    ~Arena() {
+        for (map<size_t, vector<void*>>::iterator it = free.begin(); it != free.end(); ++it) {
+            for (void* block : it->second) ::operator delete(block);
+        }
+    }
+};
+
+struct ArenaScope {
+    // New blocks come from arena until the scope ends
+    ArenaScope(Arena& arena) : saved(active) { active = &arena; }
+    ~ArenaScope() { active = saved; }
+
+    Arena* saved;
+    static thread_local Arena* active;
+};
+
+thread_local Arena* ArenaScope::active = NULL;
+
+struct BlockHeader {
+    Arena* owner;                       // NULL: taken from the heap outside any call
+    size_t units;                       // block size, in headers
+};
+
+void* poolAllocate(size_t bytes) {
+    size_t units = 1 + (bytes + sizeof(BlockHeader) - 1) / sizeof(BlockHeader);
+    Arena* arena = ArenaScope::active;
+    BlockHeader* block = NULL;
+    if (arena != NULL) {
+        vector<void*>& list = arena->free[units];
+        if (!list.empty()) {
+            block = (BlockHeader*)list.back();
+            list.pop_back();
+        }
+    }
+    if (block == NULL) block = (BlockHeader*)::operator new(units * sizeof(BlockHeader));
+    block->owner = arena;
+    block->units = units;
+    return block + 1;
+}
+
+void poolRelease(void* p) {
+    BlockHeader* block = (BlockHeader*)p - 1;
+    if (block->owner != NULL) block->owner->free[block->units].push_back(block);
+    else ::operator delete(block);
+}
+
+template <class T>
+struct Pooled {
+    typedef T value_type;
+
+    Pooled() {}
+    template <class U> Pooled(const Pooled<U>&) {}
+
+    T* allocate(size_t n) { return (T*)poolAllocate(n * sizeof(T)); }
+    void deallocate(T* p, size_t) { poolRelease(p); }
+};
+
+template <class T, class U>
+bool operator==(const Pooled<T>&, const Pooled<U>&) { return true; }
+
+template <class T, class U>
+bool operator!=(const Pooled<T>&, const Pooled<U>&) { return false; }
+
+template <class T>
+using Vec = vector<T, Pooled<T>>;
+
+
+struct Edge {
+    int flow;
+    int capacity;
+    int prev;
+    int next;
+    int lwb;
+    bool back;
+};
+
+bool operator<(const Edge& e1, const Edge& e2) {
+    if (e1.prev == e2.prev) return e1.next < e2.next;
+    return e1.prev < e2.prev;
+}
+
+typedef set<Edge, less<Edge>, Pooled<Edge>> EdgeSet;
+typedef map<int, int, less<int>, Pooled<pair<const int, int>>> FlowMap;
+
+struct Vertex {
+    int airport;
+    int time;
+    int demand;
+    int id;         // original number: 2k origin, 2k+1 destination of flight k
+    EdgeSet adj;
+};
+
+typedef Vec<Vertex> Graph;
+
+
+/*  Implicit turnaround adjacency (--implicit)
+    The turnaround neighbours of a destination vertex j are exactly the origin
+    vertices at the same airport departing at least 15 minutes after G[j].time,
+    so instead of storing those edges (and their residual copies) we keep the
+    departures of every airport sorted by time, and only remember the
+    turnaround edges that currently carry flow.
+*/
+struct Turnarounds {
+    bool implicit;
+    int capacity;                               // capacity of every turnaround edge
+    Vec<Vec<pair<int, int>>> departures;        // departures[a]: (time, origin vertex)
+    Vec<FlowMap> out;                           // out[j][i]: flow on turnaround j --> i
+    Vec<FlowMap> in;                            // in[i][j]: same flow, indexed by origin
+};
+
+/*  Compiled network snapshot (--compile / --snapshot)
+    Header, then the vertices, then the edges of every vertex in order
+    (vertex v owns edges [v.firstEdge, (v+1).firstEdge)). Plain arrays,
+    so the file can be mapped read-only and walked in place.
+*/
+struct SnapshotHeader {
+    char magic[8];                  // "AIRFLOW"
+    int format;                     // layout of the file, snapshotFormat
+    int version;                    // problem version that compiled it
+    int implicit;                   // turnarounds left implicit
+    int capacity;                   // capacity of every turnaround edge
+    int vertices;
+    int edges;
+    unsigned long long schedule;    // scheduleHash of the flights read
+};
+
+const int snapshotFormat = 3;       // bump on any change to the structs above
+
+struct SnapshotVertex {
+    int airport;
+    int time;
+    int demand;
+    int id;
+    int firstEdge;
+};
+
+
+void residual(const Graph& G, Graph& Gf) {
+    /*  Vertices are mantained. Edges change:
+        - Those edges with 0 free capacity do not appear
+        - Those edges with positive free capacity:
+            - Forward edge with value = (free capacity)
+        - Those edges with positive flow:
+            - Backward edge with value = (flow - lower bound)
+     */
+
+    for (int vf = 0; vf < Gf.size(); vf++)
+        Gf[vf].adj.clear();
+
+
+    for (Vertex v : G) {
+        for (Edge e : v.adj) {
+            if (e.capacity - e.flow > 0) {          // forward edges
+                Edge ef = {0, e.capacity - e.flow, e.prev, e.next, 0, false};
+                Gf[ef.prev].adj.insert(ef);
+            }
+            if (e.flow - e.lwb > 0) {               // backward edges
+                Edge nef = {0, e.flow - e.lwb, e.next, e.prev, 0, true};
+                Gf[nef.prev].adj.insert(nef);
+            }
+        }
+    }
+}
+
+bool isTurnaround(const Graph& G, int u, int v) {
+    // destination vertices have odd id, origin vertices even id
+    return G[u].airport >= 0 and G[v].airport >= 0 and G[u].id % 2 == 1 and G[v].id % 2 == 0;
+}
+
+int turnaroundFlow(const Turnarounds& T, int j, int i) {
+    FlowMap::const_iterator it = T.out[j].find(i);
+    if (it == T.out[j].end()) return 0;
+    return it->second;
+}
+
+void addTurnaroundFlow(Turnarounds& T, int j, int i, int f) {
+    int flow = turnaroundFlow(T, j, i) + f;
+    if (flow == 0) {
+        T.out[j].erase(i);
+        T.in[i].erase(j);
+    } else {
+        T.out[j][i] = flow;
+        T.in[i][j] = flow;
+    }
+}
+
+Vec<Edge> outEdges(const Graph& G, const Turnarounds& T, int v) {
+    // Edges of G leaving v, plus the implicit turnarounds carrying flow
+    Vec<Edge> edges(G[v].adj.begin(), G[v].adj.end());
+    if (!T.implicit or G[v].airport < 0 or G[v].id % 2 == 0) return edges;
+
+    for (pair<int, int> f : T.out[v]) {
+        Edge e = {f.second, T.capacity, v, f.first, 0, false};
+        edges.push_back(e);
+    }
+    sort(edges.begin(), edges.end());
+    return edges;
+}
+
+Vec<Edge> residualEdges(const Graph& Gf, const Turnarounds& T, int v) {
+    /*  Edges of Gf leaving v, plus the implicit turnarounds:
+        - From a destination: forward edges to every later departure at the
+          same airport (binary search + scan) with free capacity
+        - From an origin: backward edges to the destinations sending flow to it
+        Sorted as in Gf[v].adj, so the search visits them in the same order.
+     */
+    Vec<Edge> edges(Gf[v].adj.begin(), Gf[v].adj.end());
+    if (!T.implicit or Gf[v].airport < 0) return edges;
+
+    if (Gf[v].id % 2 == 1) {
+        const Vec<pair<int, int>>& deps = T.departures[Gf[v].airport];
+        Vec<pair<int, int>>::const_iterator it = lower_bound(deps.begin(), deps.end(),
+                make_pair(Gf[v].time + 15, -1));
+        for (; it != deps.end(); ++it) {
+            int free = T.capacity - turnaroundFlow(T, v, it->second);
+            if (free > 0) {
+                Edge ef = {0, free, v, it->second, 0, false};
+                edges.push_back(ef);
+            }
+        }
+    } else {
+        for (pair<int, int> f : T.in[v]) {
+            Edge nef = {0, f.second, v, f.first, 0, true};
+            edges.push_back(nef);
+        }
+    }
+    sort(edges.begin(), edges.end());
+    return edges;
+}
+
+int bottleneck(const Vec<Edge>& path) {
+    int min = path[0].capacity;
+    for (Edge e : path) {
+        if (e.capacity < min) min = e.capacity;
+    }
+    return min;
+}
+
+int augment(const Vec<Edge>& path, Graph& G, Turnarounds& T) {
+    int b = bottleneck(path);
+    for (Edge e : path) {
+
+        // e is an implicit turnaround
+        if (T.implicit and !e.back and isTurnaround(G, e.prev, e.next)) {
+            addTurnaroundFlow(T, e.prev, e.next, b);
+        }
+        else if (T.implicit and e.back and isTurnaround(G, e.next, e.prev)) {
+            addTurnaroundFlow(T, e.next, e.prev, -b);
+        }
+
+        // e is forward edge in G
+        else if (!e.back) {
+            for (Edge augEdge : G[e.prev].adj) {
+                if (augEdge.next == e.next) {
+                    G[e.prev].adj.erase(augEdge);
+                    augEdge.flow += b;
+                    G[e.prev].adj.insert(augEdge);
+                    break;
+                }
+            }
+        }
+
+        // e is backward edge in G
+        else {
+            for (Edge augEdge : G[e.next].adj) {
+                if (augEdge.next == e.prev) {
+                    G[e.next].adj.erase(augEdge);
+                    augEdge.flow -= b;
+                    G[e.next].adj.insert(augEdge);
+                    break;
+                }
+            }
+        }
+    }
+    return b;
+}
+
+Vec<Edge> BFS(const Graph& G, const Turnarounds& T, const int begin, const int end) {
+    queue<int, deque<int, Pooled<int>>> Q;
+    Vec<bool> visited(G.size(), false);
+    Vec<Edge> parent(G.size());
+
+    Q.push(begin);
+    visited[begin] = true;
+
+    int w;
+    while (not Q.empty()) {
+        w = Q.front();
+        Q.pop();
+        if (G[w].airport == G[end].airport) {
+            break;
+        }
+
+        for (Edge e : residualEdges(G, T, w)) {
+            if (!visited[e.next]) {
+                visited[e.next] = true;
+                Q.push(e.next);
+                parent[e.next] = e;
+            }
+        }
+    }
+
+    Edge p = parent[end];
+    Vec<Edge> ret;
+    if (p.next != end) return ret;
+    while (p.prev != begin) {
+        ret.push_back(p);
+        p = parent[p.prev];
+    }
+    ret.push_back(p);
+    reverse(ret.begin(), ret.end());
+    return ret;
+}
+
+int edmondsKarp(Graph& G, Turnarounds& T, bool inverted, int target,
+                Clock::time_point deadline, bool& complete) {
+    // Stops augmenting once the flow reaches target or the deadline is reached
+    // (complete = false), G keeps a feasible flow
+    Graph Gf = G;
+    residual(G, Gf);
+    int flow = 0;
+
+    int begin = Gf.size()-2;    // s
+    int end = Gf.size()-1;      // t
+
+    if (inverted) {
+        begin = Gf.size()-1;    // t
+        end = Gf.size()-2;      // s
+    }
+
+    // The greedy roster or this copy may already have spent the budget
+    if (Clock::now() >= deadline) {
+        complete = false;
+        return 0;
+    }
+    Vec<Edge> augPath = BFS(Gf, T, begin, end);
+    while (!augPath.empty()) {
+        flow += augment(augPath, G, T);
+        if (flow >= target) break;
+        residual(G, Gf);
+        if (Clock::now() >= deadline) {
+            complete = false;
+            return flow;
+        }
+        augPath = BFS(Gf, T, begin, end);
+    }
+
+    complete = true;
+    return flow;
+}
+
+void cutFlights(const Graph& G, const Turnarounds& T, int source, Vec<int>& flights) {
+    /*  Min cut certificate of a max-flow: S = vertices reachable from source
+        in the final residual graph. The edges from S to the rest are
+        saturated and their capacity is the max-flow value, so the flights
+        with an edge crossing the cut are the ones limiting it.
+     */
+    Graph Gf = G;
+    residual(G, Gf);
+
+    queue<int, deque<int, Pooled<int>>> Q;
+    Vec<bool> reachable(G.size(), false);
+    Q.push(source);
+    reachable[source] = true;
+    while (not Q.empty()) {
+        int w = Q.front();
+        Q.pop();
+        for (Edge e : residualEdges(Gf, T, w)) {
+            if (!reachable[e.next]) {
+                reachable[e.next] = true;
+                Q.push(e.next);
+            }
+        }
+    }
+
+    flights.clear();
+    for (int v = 0; v < G.size(); v++) {
+        if (!reachable[v]) continue;
+        for (Edge e : outEdges(G, T, v)) {
+            if (reachable[e.next] or e.capacity == 0) continue;
+            if (G[e.prev].airport >= 0) flights.push_back(G[e.prev].id/2);
+            if (G[e.next].airport >= 0) flights.push_back(G[e.next].id/2);
+        }
+    }
+    sort(flights.begin(), flights.end());
+    flights.erase(unique(flights.begin(), flights.end()), flights.end());
+}
+
+int edmondsKarp(Graph& G, Turnarounds& T, bool inverted) {
+    bool complete;
+    return edmondsKarp(G, T, inverted, INT_MAX, Clock::time_point::max(), complete);
+}
+
+
+
+void collectPath(Graph& G, Turnarounds& T, int version, int v, int sink,
+                 Vec<int>& first, Vec<int>& flights) {
+    // Appends the roster row of the pilot starting at v, if v reaches sink
+    queue<int, deque<int, Pooled<int>>> Q;
+    Vec<bool> visited(G.size(), false);
+    Vec<Edge> parent(G.size());
+
+    Q.push(v);
+    visited[v] = true;
+
+    int w;
+    while (not Q.empty()) {
+        w = Q.front();
+        Q.pop();
+        if (G[w].airport == G[sink].airport) {
+            break;
+        }
+
+        // version 1 follows the flights (capacity 0 after the lower bound reduction)
+        for (Edge e : outEdges(G, T, w)) {
+            if (!visited[e.next] and (e.flow > 0 or (version == 1 and e.capacity == 0))) {
+                visited[e.next] = true;
+                Q.push(e.next);
+                parent[e.next] = e;
+            }
+        }
+    }
+
+    Edge p = parent[sink];
+    Vec<Edge> ret;
+    if (p.next != sink) return;
+    while (p.prev != v) {
+        ret.push_back(p);
+        p = parent[p.prev];
+    }
+    ret.push_back(p);
+    reverse(ret.begin(), ret.end());
+
+    first.push_back(flights.size());
+    for (int i = 0; i < ret.size(); i++) {
+        if (version == 1) {
+            if (ret[i].capacity == 0) flights.push_back(G[ret[i].prev].id/2);
+            continue;
+        }
+
+        if (ret[i].flow > 0 and ret[i].lwb == 1) {
+            if (ret[i].flow == 1) flights.push_back(G[ret[i].prev].id/2);
+        }
+
+        // Update original graph
+        if (T.implicit and isTurnaround(G, ret[i].prev, ret[i].next)) {
+            addTurnaroundFlow(T, ret[i].prev, ret[i].next, -1);
+            continue;
+        }
+        EdgeSet edges = G[ret[i].prev].adj;
+        for (Edge e : edges) {
+            if (e.next == ret[i].next) {
+                G[ret[i].prev].adj.erase(e);
+                e.flow -= 1;
+                G[ret[i].prev].adj.insert(e);
+            }
+        }
+
+    }
+}
+
+void collectPaths(Graph& G, Turnarounds& T, int version, int source, int sink,
+                  Vec<int>& first, Vec<int>& flights) {
+    Vec<int> starts;
+    for (Edge startEdge : G[source].adj) {
+        if (startEdge.flow > 0) {
+            starts.push_back(startEdge.next);
+        }
+    }
+
+    first.clear();
+    flights.clear();
+    for (int v : starts) collectPath(G, T, version, v, sink, first, flights);
+    first.push_back(flights.size());
+}
+
+
+
+
+
+void updateK(Graph& G, int k) {
+    // update demands on: source, sink
+    // update capacities on: edge ss - s, edge t - tt
+
+    int sz = G.size();
+    Edge fromSStoS = {0, -(G[sz - 4].demand), sz-2, sz-4, 0, false};
+    Edge fromTtoTT = {0, G[sz - 3].demand, sz-3, sz-1, 0, false};
+
+    Edge newSSS = fromSStoS;
+    newSSS.capacity = k;
+    Edge newTTT = fromTtoTT;
+    newTTT.capacity = k;
+
+    G[sz-4].demand = -k;
+    G[sz-3].demand = k;
+
+    G[sz-2].adj.erase(fromSStoS);
+    G[sz-2].adj.insert(newSSS);
+
+    G[sz-3].adj.erase(fromTtoTT);
+    G[sz-3].adj.insert(newTTT);
+}
+
+
+void setFlow(Graph& G, Turnarounds& T, int u, int v, int flow) {
+    if (T.implicit and isTurnaround(G, u, v)) {
+        addTurnaroundFlow(T, u, v, flow - turnaroundFlow(T, u, v));
+        return;
+    }
+    for (Edge e : G[u].adj) {
+        if (e.next == v) {
+            G[u].adj.erase(e);
+            e.flow = flow;
+            G[u].adj.insert(e);
+            break;
+        }
+    }
+}
+
+int greedyChains(Graph& G, Turnarounds& T) {
+    /*  Feasible starting flow for the counter-flow: take the flights by
+        departure time and give each one to a pilot already waiting at its
+        origin airport, if any. G must start with one pilot per flight.
+        Returns the number of pilots saved.
+     */
+    int s = G.size() - 2;
+    int t = G.size() - 1;
+
+    Vec<pair<int, int>> departures;      // (time, origin vertex)
+    for (int i = 0; i < s; i++) {
+        if (G[i].id % 2 == 0) departures.push_back(make_pair(G[i].time, i));
+    }
+    sort(departures.begin(), departures.end());
+
+    // waiting[a]: (time the pilot is ready, destination vertex) at airport a
+    typedef priority_queue<pair<int, int>, Vec<pair<int, int>>, greater<pair<int, int>>> Pilots;
+    map<int, Pilots, less<int>, Pooled<pair<const int, Pilots>>> waiting;
+    int saved = 0;
+    for (pair<int, int> dep : departures) {
+        int i = dep.second;
+        int j = i;
+        for (Edge e : G[i].adj) {
+            if (e.lwb == 1) j = e.next;
+        }
+
+        if (!waiting[G[i].airport].empty() and waiting[G[i].airport].top().first <= G[i].time) {
+            int prev = waiting[G[i].airport].top().second;
+            waiting[G[i].airport].pop();
+            setFlow(G, T, prev, t, 0);
+            setFlow(G, T, s, i, 0);
+            setFlow(G, T, prev, i, 1);
+            saved++;
+        }
+        waiting[G[j].airport].push(make_pair(G[j].time + 15, j));
+    }
+    return saved;
+}
+
+int concurrencyBound(const Vec<pair<int, int>>& busy, int& peak) {
+    /*  Lower bound on the pilots: a pilot flying a flight is busy from its
+        departure until 15 minutes after its arrival, so flights overlapping
+        in those intervals need different pilots.
+        peak is a time at which the bound is reached.
+     */
+    Vec<pair<int, int>> events;
+    for (pair<int, int> b : busy) {
+        events.push_back(make_pair(b.first, 1));
+        events.push_back(make_pair(b.second, -1));
+    }
+    sort(events.begin(), events.end());     // at equal times, releases first
+
+    int current = 0;
+    int bound = 0;
+    peak = 0;
+    for (pair<int, int> ev : events) {
+        current += ev.second;
+        if (current > bound) {
+            bound = current;
+            peak = ev.first;
+        }
+    }
+    return bound;
+}
+
+void renumber(Graph& G, Vec<Vec<int>>& landings) {
+    /*  Relabel the flight vertices airport-major, time-minor, so that the
+        turnarounds of one airport are close to each other in G.
+        Vertex.id keeps the original number for the parity and output.
+     */
+    Vec<int> order(G.size());
+    for (int v = 0; v < G.size(); v++) order[v] = v;
+    sort(order.begin(), order.end(), [&G](int u, int v) {
+        if (G[u].airport != G[v].airport) return G[u].airport < G[v].airport;
+        if (G[u].time != G[v].time) return G[u].time < G[v].time;
+        return u < v;
+    });
+
+    Vec<int> label(G.size());
+    for (int v = 0; v < G.size(); v++) label[order[v]] = v;
+
+    Graph H(G.size());
+    for (int v = 0; v < G.size(); v++) {
+        H[v] = G[order[v]];
+        H[v].adj.clear();
+        for (Edge e : G[order[v]].adj) {
+            e.prev = label[e.prev];
+            e.next = label[e.next];
+            H[v].adj.insert(e);
+        }
+    }
+    for (int a = 0; a < landings.size(); a++) {
+        for (int i = 0; i < landings[a].size(); i++) landings[a][i] = label[landings[a][i]];
+    }
+    G.swap(H);
+}
+
+
+void indexDepartures(const Graph& G, Turnarounds& T) {
+    // departures[a] of every airport sorted by time, no flow on turnarounds
+    T.departures.clear();
+    for (int i = 0; i < G.size(); i++) {
+        if (G[i].airport < 0) continue;
+        if (T.departures.size() < G[i].airport + 1) T.departures.resize(G[i].airport + 1);
+        if (G[i].id % 2 == 1) continue;
+        T.departures[G[i].airport].push_back(make_pair(G[i].time, i));
+    }
+    for (int a = 0; a < T.departures.size(); a++) {
+        sort(T.departures[a].begin(), T.departures[a].end());
+    }
+    T.out.assign(G.size(), FlowMap());
+    T.in.assign(G.size(), FlowMap());
+}
+
+Vec<pair<int, int>> busyIntervals(const Graph& G) {
+    // (departure, arrival + 15) of every flight, by flight number
+    Vec<pair<int, int>> busy((G.size() - 2) / 2);
+    for (int v = 0; v < G.size(); v++) {
+        if (G[v].airport < 0 or G[v].id % 2 == 1) continue;
+        for (Edge e : G[v].adj) {
+            if (e.lwb == 1) busy[G[v].id / 2] = make_pair(G[v].time, G[e.next].time + 15);
+        }
+    }
+    return busy;
+}
+
+
+void buildNetwork(const Flight* flights, int n, const Options& options, Graph& G, Turnarounds& T) {
+    /*  Builds the network G of the flights with source and sink
+        (the last two vertices)
+     */
+    G.clear();
+    // An anytime solve cannot afford the O(F^2) turnaround edges
+    T.implicit = options.implicit or options.deadline >= 0;
+    T.departures.clear();
+    T.out.clear();
+    T.in.clear();
+
+    /*  landings[i] stores an array of indices j
+        for all j, G[j] is a destination vertex with airport = i
+    */
+    Vec<Vec<int>> landings(2);
+    for (int f = 0; f < n; f++) {
+        int o = flights[f].origin;
+        int d = flights[f].destination;
+        int to = flights[f].departure;
+        int td = flights[f].arrival;
+
+        // In airport - airport vertices, we apply lower bound <= demand reduction
+        // source.demand += edge.lowerbound
+        // dest.demand -= edge.lowerbound
+        // correct flow/capacity in edge
+
+
+        Vertex source = {o, to, 1, int(G.size())};
+        Vertex dest = {d, td, -1, int(G.size()) + 1};
+        G.push_back(source);
+        G.push_back(dest);
+        // edge from source to dest
+        int sz = G.size();
+        Edge e = {0, 0, sz - 2, sz - 1, 1, false};
+        G[sz - 2].adj.insert(e);
+        // store dest vertex in the "landings" array
+        if (landings.size() < max(o, d) + 1) landings.resize(max(o, d) + 1);
+        landings[d].push_back(sz - 1);
+    }
+
+    if (options.renumber) renumber(G, landings);
+
+    if (T.implicit) {
+        // Only index the departures of each airport by time,
+        // turnaround edges are generated on the fly during the searches
+        indexDepartures(G, T);
+    }
+    else {
+        // Iterate over all source-vertexs (those with even id)
+        for (int i = 0; i < G.size(); i++) {
+            if (G[i].id % 2 == 1) continue;
+            for (int j : landings[G[i].airport]) {
+                if (G[i].time - G[j].time >= 15) {
+                    Edge e = {0, 1, j, i, 0, false};
+                    G[j].adj.insert(e);
+                }
+            }
+        }
+    }
+
+    int maxPilots = G.size() / 2;
+    int capacity = 1;                       // of the edges leaving s and entering t
+
+    if (options.version == 2) {
+        // Update capacities for version 2
+        for (int v = 0; v < G.size(); v++) {
+            EdgeSet vEdges = G[v].adj;
+            G[v].adj.clear();
+            for (Edge e : vEdges) {
+                Edge newEdge = e;
+                newEdge.capacity = maxPilots - e.lwb;
+                G[v].adj.insert(newEdge);
+            }
+        }
+        capacity = maxPilots;
+    }
+    T.capacity = capacity;
+
+
+    // Source and sink
+    Vertex s{-1, -1, -maxPilots, int(G.size())};  // negative demand means "want to send x units"
+    Vertex t{-2, -2, maxPilots, int(G.size()) + 1};
+    G.push_back(s);
+    G.push_back(t);
+    int sz = G.size();
+    for (int i = 0; i < sz - 2; i++) {
+        if (G[i].id % 2 == 0) {
+            Edge e = {1, capacity, sz - 2, i, 0, false};
+            G[sz - 2].adj.insert(e);        // s --> G[i] (origin)
+        } else {
+            Edge e = {1, capacity, i, sz - 1, 0, false};
+            G[i].adj.insert(e);             // G[i] --> t (destination)
+        }
+    }
+}
+
+bool writeSnapshot(const string& path, int version, const Graph& G, const Turnarounds& T,
+                   unsigned long long schedule, string& error) {
+    // Airports are only compared, so they are stored as their rank,
+    // which the loader can bound by the vertex count
+    Vec<int> airports;
+    for (int v = 0; v < G.size(); v++) {
+        if (G[v].airport >= 0) airports.push_back(G[v].airport);
+    }
+    sort(airports.begin(), airports.end());
+    airports.erase(unique(airports.begin(), airports.end()), airports.end());
+
+    Vec<SnapshotVertex> vertices;
+    Vec<Edge> edges;
+    for (int v = 0; v < G.size(); v++) {
+        int airport = G[v].airport;
+        if (airport >= 0) airport = lower_bound(airports.begin(), airports.end(), airport) - airports.begin();
+        SnapshotVertex sv = {airport, G[v].time, G[v].demand, G[v].id, int(edges.size())};
+        vertices.push_back(sv);
+        for (Edge e : G[v].adj) {
+            Edge flat;
+            memset(&flat, 0, sizeof(flat));     // no garbage in the padding
+            flat = e;
+            edges.push_back(flat);
+        }
+    }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    strcpy(header.magic, "AIRFLOW");
+    header.format = snapshotFormat;
+    header.version = version;
+    header.implicit = T.implicit;
+    header.capacity = T.capacity;
+    header.vertices = vertices.size();
+    header.edges = edges.size();
+    header.schedule = schedule;
+
+    ofstream out(path.c_str(), ios::binary);
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)vertices.data(), vertices.size() * sizeof(SnapshotVertex));
+    out.write((const char*)edges.data(), edges.size() * sizeof(Edge));
+    if (!out) {
+        error = "cannot write " + path;
+        return false;
+    }
+    return true;
+}
+
+bool validSnapshot(const SnapshotHeader* header, off_t size) {
+    /*  The file may be truncated, stale or corrupt: every count and index
+        is checked before the arrays are walked
+     */
+    if (header->vertices < 2 or header->edges < 0) return false;
+    unsigned long long expected = sizeof(SnapshotHeader)
+                                  + (unsigned long long)header->vertices * sizeof(SnapshotVertex)
+                                  + (unsigned long long)header->edges * sizeof(Edge);
+    if (expected != (unsigned long long)size) return false;
+
+    const SnapshotVertex* vertices = (const SnapshotVertex*)(header + 1);
+    const Edge* edges = (const Edge*)(vertices + header->vertices);
+    int n = header->vertices;
+    if (n % 2 == 1) return false;
+
+    // Flight ids are a permutation of 0 .. n-3, the source and sink come last
+    Vec<bool> seen(n, false);
+    for (int v = 0; v < n - 2; v++) {
+        int id = vertices[v].id;
+        if (id < 0 or id >= n - 2 or seen[id]) return false;
+        seen[id] = true;
+        if (vertices[v].airport < 0 or vertices[v].airport >= n) return false;
+    }
+    for (int v = n - 2; v < n; v++) {
+        if (vertices[v].id != v or vertices[v].airport >= 0) return false;
+    }
+
+    Vec<int> vertexOf(n);
+    for (int v = 0; v < n; v++) vertexOf[vertices[v].id] = v;
+    for (int v = 0; v < n; v++) {
+        int first = vertices[v].firstEdge;
+        int last = v + 1 < n ? vertices[v + 1].firstEdge : header->edges;
+        if (first < 0 or first > last or last > header->edges) return false;
+
+        // Every origin (even id) owns exactly one flight edge, to its destination
+        bool origin = v < n - 2 and vertices[v].id % 2 == 0;
+        int flightEdges = 0;
+        for (int e = first; e < last; e++) {
+            if (edges[e].prev != v or edges[e].next < 0 or edges[e].next >= n) return false;
+            if (edges[e].lwb == 0) continue;
+            if (edges[e].lwb != 1 or !origin) return false;
+            if (edges[e].next != vertexOf[vertices[v].id + 1]) return false;
+            flightEdges++;
+        }
+        if (origin and flightEdges != 1) return false;
+    }
+    return true;
+}
+
+bool loadSnapshot(const string& path, int version, Graph& G, Turnarounds& T,
+                  unsigned long long& schedule, string& error) {
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 or fstat(fd, &st) < 0 or st.st_size < sizeof(SnapshotHeader)) {
+        error = "cannot read " + path;
+        if (fd >= 0) close(fd);
+        return false;
+    }
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        error = "cannot map " + path;
+        return false;
+    }
+
+    const SnapshotHeader* header = (const SnapshotHeader*)data;
+    const SnapshotVertex* vertices = (const SnapshotVertex*)(header + 1);
+    const Edge* edges = (const Edge*)(vertices + header->vertices);
+    string problem;
+    if (strncmp(header->magic, "AIRFLOW", sizeof(header->magic)) != 0
+            or header->format != snapshotFormat) {
+        problem = " is not a snapshot of this build";
+    } else if (header->version != version) {
+        problem = " is not a version " + to_string(version) + " snapshot";
+    } else if (!validSnapshot(header, st.st_size)) {
+        problem = " is corrupt";
+    }
+    if (!problem.empty()) {
+        error = path + problem;
+        munmap(data, st.st_size);
+        return false;
+    }
+
+    // Edges are stored sorted, so each one is inserted at the end of its set
+    G.assign(header->vertices, Vertex());
+    for (int v = 0; v < header->vertices; v++) {
+        G[v].airport = vertices[v].airport;
+        G[v].time = vertices[v].time;
+        G[v].demand = vertices[v].demand;
+        G[v].id = vertices[v].id;
+        int last = v + 1 < header->vertices ? vertices[v + 1].firstEdge : header->edges;
+        for (int e = vertices[v].firstEdge; e < last; e++) {
+            G[v].adj.insert(G[v].adj.end(), edges[e]);
+        }
+    }
+
+    T.implicit = header->implicit;
+    T.capacity = header->capacity;
+    schedule = header->schedule;
+    T.departures.clear();
+    T.out.clear();
+    T.in.clear();
+    if (T.implicit) indexDepartures(G, T);
+
+    munmap(data, st.st_size);
+    return true;
+}
+
+}   // namespace
+
+
+struct Workspace::State {
+    Arena arena;                // first member: outlives the containers below
+    Graph G;
+    Graph fresh;
+    Turnarounds T;
+    Turnarounds freshT;
+    Vec<pair<int, int>> busy;
+    Vec<int> first;             // roster rows
+    Vec<int> flights;           // roster flights, or bottleneck flights
+};
+
+Workspace::Workspace() : state(new State()) {}
+
+Workspace::~Workspace() {
+    delete state;
+}
+
+Options defaultOptions(int version) {
+    Options options = {version, false, false, -1, -1};
+    return options;
+}
+
+namespace {
+
+Result roster(Workspace::State& st, int pilots, bool optimal, int gap) {
+    Result result = {true, pilots, optimal, gap, int(st.first.size()) - 1,
+                     st.first.data(), st.flights.data(), 0, 0};
+    return result;
+}
+
+Result infeasible(Workspace::State& st) {
+    Result result = {false, 0, false, 0, 0, st.first.data(), st.flights.data(),
+                     int(st.flights.size()), 0};
+    return result;
+}
+
+Result solveNetwork(Workspace::State& st, const Options& options, Clock::time_point start) {
+    /*  Solves the network in st.G, built with its source and sink:
+        counter-flow for the minimum, then the circulation with that many
+        pilots for the roster (or the variants asked by options)
+     */
+    Graph& G = st.G;
+    Turnarounds& T = st.T;
+    if (G.size() == 2) {
+        // No flights (only s and t): the empty roster, which every query accepts
+        st.first.assign(1, 0);
+        st.flights.clear();
+        return roster(st, 0, true, 0);
+    }
+    int maxPilots = (G.size() - 2) / 2;
+    st.busy = busyIntervals(G);
+
+    if (options.deadline >= 0) {
+        // Anytime solve: start from a greedy roster and improve it with the
+        // counter-flow until it is optimal or the deadline is reached
+        int saved = greedyChains(G, T);
+        bool complete;
+        int counterFlow = edmondsKarp(G, T, true, INT_MAX,
+                                      start + chrono::milliseconds(options.deadline), complete);
+        int pilots = maxPilots - saved - counterFlow;
+        int peak;
+        int bound = concurrencyBound(st.busy, peak);
+        bool optimal = complete or pilots == bound;
+
+        if (options.version == 2) {
+            // Flights carry their lower bound on top of the stored flow
+            for (int v = 0; v < G.size() - 2; v++) {
+                if (G[v].id % 2 == 1) continue;
+                EdgeSet vEdges = G[v].adj;
+                for (Edge e : vEdges) {
+                    if (G[e.next].id == G[v].id + 1) {
+                        G[v].adj.erase(e);
+                        e.flow += e.lwb;
+                        G[v].adj.insert(e);
+                    }
+                }
+            }
+        }
+        collectPaths(G, T, options.version, G.size() - 2, G.size() - 1, st.first, st.flights);
+        return roster(st, pilots, optimal, optimal ? 0 : pilots - bound);
+    }
+
+    int query = options.feasible;
+    int bound = 0;                  // lower bound for the gap of a query's roster
+    if (query >= 0) {
+        // Cheap certificate: more flights overlap at some time than pilots
+        int peak;
+        bound = concurrencyBound(st.busy, peak);
+        if (bound > query) {
+            st.first.clear();
+            st.flights.clear();
+            for (int f = 0; f < st.busy.size(); f++) {
+                if (st.busy[f].first <= peak and peak < st.busy[f].second) st.flights.push_back(f);
+            }
+            return infeasible(st);
+        }
+    }
+
+    // Check maximum counter-flow: maxPilots - maxCounterFlow = minimum pilots required
+    // (skipped when asked about a given k: only its circulation is built)
+
+    Graph& fresh = st.fresh;
+    fresh = G;
+    st.freshT = T;
+
+    int k = min(query, maxPilots);  // no roster needs more than a pilot per flight
+    if (query < 0) k = maxPilots - edmondsKarp(G, T, true);
+
+    // Restore graph to the original form
+
+    // Clean flow in edges s - u
+    EdgeSet sEdges = fresh[G.size()-2].adj;
+    fresh[G.size()-2].adj.clear();
+    for (Edge e : sEdges) {
+        e.flow = 0;
+        fresh[G.size()-2].adj.insert(e);
+    }
+
+    // Clean flow in edges v - t
+    for (int vt = 0; vt < fresh.size() - 2; vt++) {
+        if (fresh[vt].id % 2 == 0) continue;
+        EdgeSet vertexEdges = fresh[vt].adj;
+        for (Edge e : vertexEdges) {
+            if (e.next == G.size()-1) {
+                fresh[vt].adj.erase(e);
+                e.flow = 0;
+                fresh[vt].adj.insert(e);
+                break;
+            }
+        }
+    }
+
+    // reduce "circulation with demands" to "maximum flow"
+    // add super-source ss and super-sink tt
+    // for each vertex with negative demand (send), add Edge(ss, v) with capacity -v.demand
+    // for each vertex with positive demand (receive), add Edge(v, tt) with capacity v.demand
+
+    Vertex ss = {-3, -3, 0, int(fresh.size())};
+    Vertex tt = {-4, -4, 0, int(fresh.size()) + 1};
+    fresh.push_back(ss);
+    fresh.push_back(tt);
+    int sz = fresh.size();
+
+    for (int i = 0; i < sz - 4; i++) {
+        if (fresh[i].id % 2 == 0) continue;
+        Edge e = {0, -(fresh[i].demand), sz-2, i, 0, false};
+        fresh[sz-2].adj.insert(e);
+    }
+    for (int j = 0; j < sz - 4; j++) {
+        if (fresh[j].id % 2 == 1) continue;
+        Edge e = {0, fresh[j].demand, j, sz-1, 0, false};
+        fresh[j].adj.insert(e);
+    }
+
+
+    Edge fromSStoS = {0, -(fresh[sz - 4].demand), sz-2, sz-4, 0, false};
+    fresh[sz-2].adj.insert(fromSStoS);
+
+    Edge fromTtoTT = {0, fresh[sz - 3].demand, sz-3, sz-1, 0, false};
+    fresh[sz-3].adj.insert(fromTtoTT);
+
+    if (query >= 0) {
+        // A query asks for at most k pilots: the rest may stay idle (s --> t)
+        Edge idle = {0, k, sz-4, sz-3, 0, false};
+        fresh[sz-4].adj.insert(idle);
+    }
+
+    // The circulation exists iff every edge leaving ss is saturated
+    updateK(fresh, k);
+    bool complete;
+    int optFlow = edmondsKarp(fresh, st.freshT, false, maxPilots + k,
+                              Clock::time_point::max(), complete) - maxPilots;
+
+    // Only a feasibility query can fail here: when minimizing, k comes from
+    // the counter-flow and the roster is returned as it is
+    if (query >= 0 and optFlow < k) {
+        // No augmenting path left: the side reachable from ss is a cut
+        // below the required value, report the flights crossing it
+        st.first.clear();
+        cutFlights(fresh, st.freshT, sz - 2, st.flights);
+        return infeasible(st);
+    }
+
+    for (Edge e : fresh[sz - 4].adj) {
+        if (e.next == sz - 3) optFlow -= e.flow;     // idle pilots
+    }
+
+    if (options.version == 2) {
+        for (int v = 0; v < fresh.size() -4; v++) {
+            if (fresh[v].id % 2 == 1) continue;
+            EdgeSet vEdges = fresh[v].adj;
+            for (Edge e : vEdges) {
+                if (e.next == fresh.size()-1) {
+                    int flow = e.flow;
+                    for (Edge e2 : vEdges) {
+                        if (fresh[e2.next].id == fresh[e2.prev].id + 1) {
+                            Edge newEdge = e2;
+                            fresh[v].adj.erase(e2);
+                            newEdge.flow += flow;
+                            fresh[v].adj.insert(newEdge);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    collectPaths(fresh, st.freshT, options.version, fresh.size() - 4, fresh.size() - 3,
+                 st.first, st.flights);
+    // A query's roster is only known to be minimum if it meets the lower bound
+    bool optimal = query < 0 or optFlow == bound;
+    return roster(st, optFlow, optimal, optimal ? 0 : optFlow - bound);
+}
+
+bool validVersion(const Options& options, string& error) {
+    if (options.version == 1 or options.version == 2) return true;
+    error = "unknown problem version " + to_string(options.version);
+    return false;
+}
+
+}   // namespace
+
+
+unsigned long long scheduleHash(const Flight* flights, int n) {
+    unsigned long long hash = 14695981039346656037ULL;      // FNV-1a
+    for (int f = 0; f < n; f++) {
+        for (int x : {flights[f].origin, flights[f].destination,
+                      flights[f].departure, flights[f].arrival}) {
+            hash = (hash ^ (unsigned int)(x)) * 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+bool solve(const Flight* flights, int n, const Options& options, Workspace& ws, Result& result) {
+    if (!validVersion(options, ws.error)) return false;
+    Clock::time_point start = Clock::now();
+    ArenaScope scope(ws.state->arena);
+    buildNetwork(flights, n, options, ws.state->G, ws.state->T);
+    result = solveNetwork(*ws.state, options, start);
+    result.schedule = scheduleHash(flights, n);
+    return true;
+}
+
+bool compileNetwork(const Flight* flights, int n, const Options& options,
+                    const string& path, Workspace& ws) {
+    if (!validVersion(options, ws.error)) return false;
+    ArenaScope scope(ws.state->arena);
+    buildNetwork(flights, n, options, ws.state->G, ws.state->T);
+    return writeSnapshot(path, options.version, ws.state->G, ws.state->T,
+                         scheduleHash(flights, n), ws.error);
+}
+
+bool solveSnapshot(const string& path, const Options& options, Workspace& ws, Result& result) {
+    if (!validVersion(options, ws.error)) return false;
+    Clock::time_point start = Clock::now();
+    ArenaScope scope(ws.state->arena);
+    unsigned long long schedule;
+    if (!loadSnapshot(path, options.version, ws.state->G, ws.state->T, schedule, ws.error)) {
+        return false;
+    }
+    result = solveNetwork(*ws.state, options, start);
+    result.schedule = schedule;
+    return true;
+}
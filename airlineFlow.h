@@ -0,0 +1,81 @@
+#ifndef AIRLINE_FLOW_H
+#define AIRLINE_FLOW_H
+
+#include <string>
+
+/*  In-process airline scheduling solver
+    The flights are read from a caller's array and the rosters are returned as
+    index arrays into it. All the memory of a solve comes from the Workspace,
+    which recycles it between calls: from the third call on the same schedule
+    (and options), a solve takes nothing from the heap. Another schedule still
+    allocates until the workspace has blocks of every size it needs.
+*/
+
+struct Flight {
+    int origin;
+    int destination;
+    int departure;
+    int arrival;
+};
+
+struct Options {
+    int version;        // 1: pilots only fly their flights, 2: they may travel as passengers
+                        // (any other is rejected)
+    bool implicit;      // turnaround edges generated during the searches
+    bool renumber;      // vertices relabeled airport-major, time-minor
+    int deadline;       // milliseconds for an anytime solve, -1 for an exact solve
+    int feasible;       // pilots available for a feasibility query, -1 to minimize
+};
+
+struct Result {
+    bool feasible;      // false only if a feasibility query failed
+    int pilots;         // pilots of the roster
+    bool optimal;       // optimality proven (always true when minimizing without deadline)
+    int gap;            // pilots above the lower bound (most flights in the air at once),
+                        // 0 if optimal or the query failed
+
+    /*  Roster: one row per pilot, row r holds the flights
+        flights[first[r]] .. flights[first[r + 1] - 1] (indices into the input)
+        If the query failed, flights[0 .. bottlenecks - 1] are the bottleneck flights.
+        The arrays belong to the workspace and stay valid until its next call.
+     */
+    int rows;
+    const int* first;
+    const int* flights;
+    int bottlenecks;
+
+    unsigned long long schedule;    // scheduleHash of the flights solved
+};
+
+struct Workspace {
+    Workspace();
+    ~Workspace();
+
+    std::string error;  // why the last call failed
+
+    struct State;
+    State* state;
+
+private:
+    Workspace(const Workspace&);
+    Workspace& operator=(const Workspace&);
+};
+
+Options defaultOptions(int version);
+
+// Hash of the n flights, to tell whether a snapshot was compiled from them
+unsigned long long scheduleHash(const Flight* flights, int n);
+
+// Minimum roster (or as asked by options) of the n flights, false on error
+bool solve(const Flight* flights, int n, const Options& options, Workspace& ws, Result& result);
+
+// Writes the network of the n flights to a snapshot file, false on error
+bool compileNetwork(const Flight* flights, int n, const Options& options,
+                    const std::string& path, Workspace& ws);
+
+/*  Solves a network previously compiled with the same version, false on error
+    (or if the file is corrupt). result.schedule is the hash stored at compile time.
+ */
+bool solveSnapshot(const std::string& path, const Options& options, Workspace& ws, Result& result);
+
+#endif